@@ -1,18 +1,25 @@
+#include <algorithm>
 #include <atomic>
+#include <cctype>
 #include <chrono>
+#include <climits>
 #include <ctime>
 #include <filesystem>
 #include <iostream>
 #include <map>
 #include <mutex>
+#include <stdexcept>
 #include <string>
 #include <thread>
+#include <vector>
 
 // POSIX socket headers
+#include <arpa/inet.h>
 #include <sys/socket.h>
 #include <sys/un.h>
 #include <unistd.h>
 #include <signal.h>
+#include <pthread.h>
 #include <pwd.h>
 #include <sys/stat.h>
 
@@ -37,6 +44,42 @@ int socket_fd = -1;
 std::string socket_path;
 std::mutex hid_mutex;
 
+// Hot-restart state
+int handoff_fd = -1;
+int handoff_conn = -1;  // kept open until our VHD client is torn down
+std::string handoff_path;
+bool owns_socket_path = false;
+std::atomic<bool> handed_off(false);
+
+// Last reported device state (guarded by hid_mutex).
+// This is what a successor process replays after a hot restart.
+struct held_state {
+  std::vector<uint32_t> keys;
+  uint32_t modifiers = 0;
+  uint32_t buttons = 0;
+};
+held_state held;
+bool restore_keyboard_pending = false;
+bool restore_pointing_pending = false;
+
+// Longest a single command may block the server loop. A successor waiting
+// for a handoff must outlast it.
+constexpr int max_press_ms = 30000;
+constexpr int handoff_timeout_ms = max_press_ms + 5000;
+
+// How long a successor waits for the predecessor's VHD teardown.
+constexpr int predecessor_teardown_timeout_ms = 10000;
+
+// A keyboard_input report holds at most 32 keys.
+constexpr size_t max_keyboard_keys = 32;
+constexpr uint32_t max_handoff_payload = 64 * 1024;
+
+enum class takeover_result {
+  taken_over,
+  no_instance,
+  failed,
+};
+
 std::unique_ptr<pqrs::karabiner::driverkit::virtual_hid_device_service::client> vhid_client;
 
 // Key name to HID usage code mapping
@@ -94,6 +137,15 @@ std::map<std::string, pqrs::hid::usage::value_t> key_map = {
     {"right", pqrs::hid::usage::keyboard_or_keypad::keyboard_right_arrow},
 };
 
+// SIGINT/SIGTERM, deferred around a handoff
+sigset_t shutdown_signal_set() {
+  sigset_t signals;
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGINT);
+  sigaddset(&signals, SIGTERM);
+  return signals;
+}
+
 // Signal handler for graceful shutdown
 void signal_handler(int signal) {
   std::cout << "Received signal " << signal << ", shutting down..." << std::endl;
@@ -104,10 +156,60 @@ void signal_handler(int signal) {
     close(socket_fd);
   }
 
-  // Unlink socket file
-  if (!socket_path.empty()) {
-    unlink(socket_path.c_str());
+  if (handoff_fd >= 0) {
+    close(handoff_fd);
+  }
+
+  // Unlink socket files we created (a successor owns them after a handoff)
+  if (!handed_off) {
+    if (!socket_path.empty() && owns_socket_path) {
+      unlink(socket_path.c_str());
+    }
+    if (handoff_fd >= 0) {
+      unlink(handoff_path.c_str());
+    }
+  }
+}
+
+// Post reports and remember what is currently held down.
+// Caller must hold hid_mutex.
+void post_keyboard_report(const std::vector<uint32_t>& keys, uint32_t modifiers) {
+  using modifier = pqrs::karabiner::driverkit::virtual_hid_device_driver::hid_report::modifier;
+
+  pqrs::karabiner::driverkit::virtual_hid_device_driver::hid_report::keyboard_input report;
+  for (const auto& usage : keys) {
+    report.keys.insert(usage);
   }
+  // Apply modifier bitmask (Karabiner expects individual modifier entries)
+  if (modifiers & 0x01) report.modifiers.insert(modifier::left_control);
+  if (modifiers & 0x02) report.modifiers.insert(modifier::left_shift);
+  if (modifiers & 0x04) report.modifiers.insert(modifier::left_option);
+  if (modifiers & 0x08) report.modifiers.insert(modifier::left_command);
+  if (modifiers & 0x10) report.modifiers.insert(modifier::right_control);
+  if (modifiers & 0x20) report.modifiers.insert(modifier::right_shift);
+  if (modifiers & 0x40) report.modifiers.insert(modifier::right_option);
+  if (modifiers & 0x80) report.modifiers.insert(modifier::right_command);
+  vhid_client->async_post_report(report);
+
+  held.keys = keys;
+  held.modifiers = modifiers;
+}
+
+void post_pointing_report(int x, int y, int vertical_wheel, int horizontal_wheel, uint32_t buttons) {
+  pqrs::karabiner::driverkit::virtual_hid_device_driver::hid_report::pointing_input report;
+  report.x = static_cast<int8_t>(x);
+  report.y = static_cast<int8_t>(y);
+  report.vertical_wheel = static_cast<int8_t>(vertical_wheel);
+  report.horizontal_wheel = static_cast<int8_t>(horizontal_wheel);
+  // Buttons as a bitfield (bitmask, 1=left, 2=right, 4=middle, etc.)
+  for (int i = 0; i < 8; ++i) {
+    if ((buttons & (1u << i)) != 0) {
+      report.buttons.insert(i + 1);
+    }
+  }
+  vhid_client->async_post_report(report);
+
+  held.buttons = buttons;
 }
 
 // Setup VHD client
@@ -212,23 +314,22 @@ json handle_click(const json& cmd) {
       return resp;
     }
 
+    if (press_ms < 0 || press_ms > max_press_ms) {
+      resp["status"] = "error";
+      resp["message"] = "press must be between 0 and " + std::to_string(max_press_ms);
+      return resp;
+    }
+
     std::lock_guard<std::mutex> lock(hid_mutex);
 
     if (vhid_client) {
       // Button down
-      {
-        pqrs::karabiner::driverkit::virtual_hid_device_driver::hid_report::pointing_input report;
-        report.buttons.insert(button);
-        vhid_client->async_post_report(report);
-      }
+      post_pointing_report(0, 0, 0, 0, 1u << (button - 1));
 
       std::this_thread::sleep_for(std::chrono::milliseconds(press_ms));
 
       // Button up
-      {
-        pqrs::karabiner::driverkit::virtual_hid_device_driver::hid_report::pointing_input report;
-        vhid_client->async_post_report(report);
-      }
+      post_pointing_report(0, 0, 0, 0, 0);
 
       resp["status"] = "ok";
     } else {
@@ -262,22 +363,12 @@ json handle_move(const json& cmd) {
 
     if (vhid_client) {
       // Move
-      {
-        pqrs::karabiner::driverkit::virtual_hid_device_driver::hid_report::pointing_input report;
-        report.x = static_cast<int8_t>(x);
-        report.y = static_cast<int8_t>(y);
-        vhid_client->async_post_report(report);
-      }
+      post_pointing_report(x, y, 0, 0, 0);
 
       std::this_thread::sleep_for(std::chrono::milliseconds(10));
 
       // Stop movement
-      {
-        pqrs::karabiner::driverkit::virtual_hid_device_driver::hid_report::pointing_input report;
-        report.x = 0;
-        report.y = 0;
-        vhid_client->async_post_report(report);
-      }
+      post_pointing_report(0, 0, 0, 0, 0);
 
       resp["status"] = "ok";
     } else {
@@ -333,45 +424,36 @@ json handle_key(const json& cmd) {
       return resp;
     }
 
+    std::vector<uint32_t> keys = {static_cast<uint32_t>(type_safe::get(key_usage))};
+
     if (action == "down") {
       // Key down only
-      pqrs::karabiner::driverkit::virtual_hid_device_driver::hid_report::keyboard_input report;
-      report.keys.insert(type_safe::get(key_usage));
-      vhid_client->async_post_report(report);
+      post_keyboard_report(keys, 0);
     } else if (action == "up") {
       // Key up only
-      pqrs::karabiner::driverkit::virtual_hid_device_driver::hid_report::keyboard_input report;
-      vhid_client->async_post_report(report);
+      post_keyboard_report({}, 0);
     } else if (action == "press") {
       // Key down + up
-      {
-        pqrs::karabiner::driverkit::virtual_hid_device_driver::hid_report::keyboard_input report;
-        report.keys.insert(type_safe::get(key_usage));
-        vhid_client->async_post_report(report);
-      }
+      post_keyboard_report(keys, 0);
 
       std::this_thread::sleep_for(std::chrono::milliseconds(50));
 
-      {
-        pqrs::karabiner::driverkit::virtual_hid_device_driver::hid_report::keyboard_input report;
-        vhid_client->async_post_report(report);
-      }
+      post_keyboard_report({}, 0);
     } else if (action == "hold") {
       // Hold for duration
       int press_ms = cmd.value("press", 1000);
 
-      {
-        pqrs::karabiner::driverkit::virtual_hid_device_driver::hid_report::keyboard_input report;
-        report.keys.insert(type_safe::get(key_usage));
-        vhid_client->async_post_report(report);
+      if (press_ms < 0 || press_ms > max_press_ms) {
+        resp["status"] = "error";
+        resp["message"] = "press must be between 0 and " + std::to_string(max_press_ms);
+        return resp;
       }
 
+      post_keyboard_report(keys, 0);
+
       std::this_thread::sleep_for(std::chrono::milliseconds(press_ms));
 
-      {
-        pqrs::karabiner::driverkit::virtual_hid_device_driver::hid_report::keyboard_input report;
-        vhid_client->async_post_report(report);
-      }
+      post_keyboard_report({}, 0);
     } else {
       resp["status"] = "error";
       resp["message"] = "unknown action: " + action;
@@ -422,20 +504,7 @@ json handle_command(const json& cmd) {
         int buttons = cmd.value("buttons", 0);
         std::lock_guard<std::mutex> lock(hid_mutex);
         if (vhid_client) {
-          pqrs::karabiner::driverkit::virtual_hid_device_driver::hid_report::pointing_input report;
-          report.x = static_cast<int8_t>(x);
-          report.y = static_cast<int8_t>(y);
-          report.vertical_wheel = static_cast<int8_t>(vertical_wheel);
-          report.horizontal_wheel = static_cast<int8_t>(horizontal_wheel);
-          // Set buttons as a bitfield (bitmask, 1=left, 2=right, 4=middle, etc.)
-          if (buttons != 0) {
-            for (int i = 0; i < 8; ++i) {
-              if ((buttons & (1 << i)) != 0) {
-                report.buttons.insert(i + 1);
-              }
-            }
-          }
-          vhid_client->async_post_report(report);
+          post_pointing_report(x, y, vertical_wheel, horizontal_wheel, static_cast<uint32_t>(buttons));
           resp["status"] = "ok";
           resp["message"] = "mouse event sent";
         } else {
@@ -458,9 +527,16 @@ json handle_command(const json& cmd) {
         return resp;
       }
       try {
-        std::vector<int> keys;
+        std::vector<uint32_t> keys;
         if (cmd.contains("keys") && cmd["keys"].is_array()) {
-          keys = cmd["keys"].get<std::vector<int>>();
+          for (const auto& usage : cmd["keys"].get<std::vector<int>>()) {
+            keys.push_back(static_cast<uint32_t>(usage));
+          }
+          if (keys.size() > max_keyboard_keys) {
+            resp["status"] = "error";
+            resp["message"] = "too many keys (max " + std::to_string(max_keyboard_keys) + ")";
+            return resp;
+          }
         } else {
           resp["status"] = "error";
           resp["message"] = "missing or invalid 'keys' field";
@@ -469,26 +545,7 @@ json handle_command(const json& cmd) {
         int modifiers = cmd.value("modifiers", 0);
         std::lock_guard<std::mutex> lock(hid_mutex);
         if (vhid_client) {
-          pqrs::karabiner::driverkit::virtual_hid_device_driver::hid_report::keyboard_input report;
-          for (const auto& usage : keys) {
-            report.keys.insert(static_cast<uint32_t>(usage));
-          }
-          // Apply modifier bitmask (Karabiner expects individual modifier entries)
-          {
-            auto apply_modifiers = [](uint32_t m, auto& mods) {
-              using modifier = pqrs::karabiner::driverkit::virtual_hid_device_driver::hid_report::modifier;
-              if (m & 0x01) mods.insert(modifier::left_control);
-              if (m & 0x02) mods.insert(modifier::left_shift);
-              if (m & 0x04) mods.insert(modifier::left_option);
-              if (m & 0x08) mods.insert(modifier::left_command);
-              if (m & 0x10) mods.insert(modifier::right_control);
-              if (m & 0x20) mods.insert(modifier::right_shift);
-              if (m & 0x40) mods.insert(modifier::right_option);
-              if (m & 0x80) mods.insert(modifier::right_command);
-            };
-            apply_modifiers(static_cast<uint32_t>(modifiers), report.modifiers);
-          }
-          vhid_client->async_post_report(report);
+          post_keyboard_report(keys, static_cast<uint32_t>(modifiers));
           resp["status"] = "ok";
           resp["message"] = "keyboard event sent";
         } else {
@@ -519,12 +576,486 @@ json handle_command(const json& cmd) {
   }
 }
 
+// Try to connect to a Unix socket. Returns 0 if something accepted the
+// connection, otherwise the connect() errno (ENOENT, ECONNREFUSED, ...).
+int probe_socket(const std::string& path) {
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    return errno;
+  }
+
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+  int error = connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 ? errno : 0;
+  close(fd);
+  return error;
+}
+
+// Create, bind and listen on a Unix socket. Returns -1 on failure.
+// The caller removes any stale socket file at `path` first.
+int create_listen_socket(const std::string& path, mode_t mode, uid_t uid) {
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    std::cerr << "Failed to create socket: " << strerror(errno) << std::endl;
+    return -1;
+  }
+
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+  if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+    std::cerr << "Failed to bind socket " << path << ": " << strerror(errno) << std::endl;
+    close(fd);
+    return -1;
+  }
+
+  // Set permissions
+  if (chmod(path.c_str(), mode) < 0) {
+    std::cerr << "Failed to chmod socket: " << strerror(errno) << std::endl;
+  }
+
+  if (chown(path.c_str(), uid, 0) < 0) {
+    std::cerr << "Failed to chown socket: " << strerror(errno) << std::endl;
+  }
+
+  if (listen(fd, 5) < 0) {
+    std::cerr << "Failed to listen on socket: " << strerror(errno) << std::endl;
+    close(fd);
+    unlink(path.c_str());
+    return -1;
+  }
+
+  return fd;
+}
+
+// Held state and socket ownership snapshot passed to a successor process.
+// Caller must hold hid_mutex.
+json snapshot_held_state() {
+  json state;
+  state["version"] = 1;
+  state["keyboard"]["keys"] = held.keys;
+  state["keyboard"]["modifiers"] = held.modifiers;
+  state["pointing"]["buttons"] = held.buttons;
+  state["socket"]["owns_path"] = owns_socket_path;
+  return state;
+}
+
+// Parse a snapshot from snapshot_held_state(). Throws on malformed input.
+held_state parse_held_state(const json& state) {
+  if (state.at("version").get<int>() != 1) {
+    throw std::runtime_error("unknown handoff state version");
+  }
+
+  held_state parsed;
+  const json& keyboard = state.at("keyboard");
+  parsed.keys = keyboard.at("keys").get<std::vector<uint32_t>>();
+  if (parsed.keys.size() > max_keyboard_keys) {
+    throw std::runtime_error("too many held keys");
+  }
+  parsed.modifiers = keyboard.at("modifiers").get<uint32_t>();
+  parsed.buttons = state.at("pointing").at("buttons").get<uint32_t>();
+  return parsed;
+}
+
+void load_held_state(const held_state& state) {
+  std::lock_guard<std::mutex> lock(hid_mutex);
+
+  held = state;
+  restore_keyboard_pending = !held.keys.empty() || held.modifiers != 0;
+  restore_pointing_pending = held.buttons != 0;
+}
+
+// Replay held keys/buttons received from the predecessor once devices are ready.
+void restore_held_state() {
+  std::lock_guard<std::mutex> lock(hid_mutex);
+
+  if (!vhid_client) {
+    return;
+  }
+
+  if (restore_keyboard_pending && keyboard_ready) {
+    std::cout << "Restoring " << held.keys.size() << " held keys" << std::endl;
+    post_keyboard_report(held.keys, held.modifiers);
+    restore_keyboard_pending = false;
+  }
+
+  if (restore_pointing_pending && pointing_ready) {
+    std::cout << "Restoring held buttons: " << held.buttons << std::endl;
+    post_pointing_report(0, 0, 0, 0, held.buttons);
+    restore_pointing_pending = false;
+  }
+}
+
+// Read or write exactly `len` bytes on a stream socket.
+bool read_fully(int fd, char* buffer, size_t len) {
+  while (len > 0) {
+    ssize_t n = read(fd, buffer, len);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) {
+      std::cerr << "read error: " << (n < 0 ? strerror(errno) : "connection closed") << std::endl;
+      return false;
+    }
+    buffer += n;
+    len -= static_cast<size_t>(n);
+  }
+  return true;
+}
+
+bool write_fully(int fd, const char* buffer, size_t len) {
+  while (len > 0) {
+    ssize_t n = write(fd, buffer, len);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) {
+      std::cerr << "write error: " << strerror(errno) << std::endl;
+      return false;
+    }
+    buffer += n;
+    len -= static_cast<size_t>(n);
+  }
+  return true;
+}
+
+// Send `payload` with a 4-byte big-endian length prefix, together with `fd`
+// as SCM_RIGHTS ancillary data on the first byte.
+bool send_fd(int conn, int fd, const std::string& payload) {
+  uint32_t length = htonl(static_cast<uint32_t>(payload.size()));
+  std::string message(reinterpret_cast<const char*>(&length), sizeof(length));
+  message += payload;
+
+  struct iovec iov;
+  iov.iov_base = message.data();
+  iov.iov_len = message.size();
+
+  char control[CMSG_SPACE(sizeof(int))];
+  memset(control, 0, sizeof(control));
+
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+
+  struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+  memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+
+  ssize_t n = sendmsg(conn, &msg, 0);
+  if (n <= 0) {
+    std::cerr << "sendmsg error: " << strerror(errno) << std::endl;
+    return false;
+  }
+
+  // Stream sockets may accept a partial write; send the rest without the fd.
+  return write_fully(conn, message.data() + n, message.size() - static_cast<size_t>(n));
+}
+
+// Receive a length-prefixed payload and one SCM_RIGHTS fd. Returns -1 on failure.
+int receive_fd(int conn, std::string& payload) {
+  uint32_t length = 0;
+  struct iovec iov;
+  iov.iov_base = &length;
+  iov.iov_len = sizeof(length);
+
+  char control[CMSG_SPACE(sizeof(int))];
+  memset(control, 0, sizeof(control));
+
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+
+  ssize_t n = recvmsg(conn, &msg, 0);
+  if (n <= 0) {
+    std::cerr << "recvmsg error: " << (n < 0 ? strerror(errno) : "connection closed") << std::endl;
+    return -1;
+  }
+
+  int fd = -1;
+  for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+    if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+      memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+    }
+  }
+
+  if (fd < 0 || (msg.msg_flags & MSG_CTRUNC) != 0) {
+    std::cerr << "Invalid handoff message" << std::endl;
+    if (fd >= 0) {
+      close(fd);
+    }
+    return -1;
+  }
+
+  // Finish the length prefix, then the payload itself.
+  if (!read_fully(conn, reinterpret_cast<char*>(&length) + n, sizeof(length) - static_cast<size_t>(n))) {
+    close(fd);
+    return -1;
+  }
+
+  length = ntohl(length);
+  if (length > max_handoff_payload) {
+    std::cerr << "Handoff payload too large: " << length << " bytes" << std::endl;
+    close(fd);
+    return -1;
+  }
+
+  payload.resize(length);
+  if (!read_fully(conn, payload.data(), length)) {
+    close(fd);
+    return -1;
+  }
+
+  return fd;
+}
+
+// Handoff peers must be root or run as the same user as this process.
+bool is_trusted_peer(int conn) {
+  uid_t peer_uid;
+  gid_t peer_gid;
+  if (getpeereid(conn, &peer_uid, &peer_gid) < 0) {
+    std::cerr << "getpeereid error: " << strerror(errno) << std::endl;
+    return false;
+  }
+  return peer_uid == 0 || peer_uid == geteuid();
+}
+
+// Old process side: hand the listening socket and held state to a successor.
+// The listen backlog (connections not yet accepted) travels with the fd.
+void serve_handoff() {
+  int conn = accept(handoff_fd, nullptr, nullptr);
+  if (conn < 0) {
+    if (errno != EINTR) {
+      std::cerr << "handoff accept error: " << strerror(errno) << std::endl;
+    }
+    return;
+  }
+
+  if (!is_trusted_peer(conn)) {
+    std::cerr << "Rejecting handoff from unauthorized peer" << std::endl;
+    close(conn);
+    return;
+  }
+
+  struct timeval timeout;
+  timeout.tv_sec = 5;
+  timeout.tv_usec = 0;
+  setsockopt(conn, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+  // Defer shutdown signals until handed_off is final, so the handler
+  // never unlinks paths a successor is about to own.
+  sigset_t shutdown_signals = shutdown_signal_set();
+  pthread_sigmask(SIG_BLOCK, &shutdown_signals, nullptr);
+
+  std::string state;
+  {
+    std::lock_guard<std::mutex> lock(hid_mutex);
+    state = snapshot_held_state().dump();
+  }
+
+  std::cout << "Handing off listening socket: " << state << std::endl;
+
+  // Keep serving unless the successor confirms it owns the socket.
+  bool acknowledged = false;
+  if (send_fd(conn, socket_fd, state)) {
+    char ack[2];
+    acknowledged = read_fully(conn, ack, sizeof(ack)) && memcmp(ack, "ok", 2) == 0;
+  }
+
+  if (acknowledged) {
+    // The successor waits for EOF on `conn` before replaying held state,
+    // so keep it open until our VHD client has been destroyed.
+    std::cout << "Handoff complete, exiting." << std::endl;
+    handoff_conn = conn;
+    handed_off = true;
+    exit_flag = true;
+  } else {
+    std::cerr << "Handoff not acknowledged, continuing to serve" << std::endl;
+    close(conn);
+  }
+
+  pthread_sigmask(SIG_UNBLOCK, &shutdown_signals, nullptr);
+}
+
+// New process side: take over the listening socket from a running instance.
+// On success `fd` is the listening socket and `owns_path` tells whether the
+// predecessor created socket_path (false if a supervisor did). `no_instance`
+// means nothing serves either the handoff socket or socket_path; any other
+// failure leaves the running instance serving.
+takeover_result request_takeover(int& fd, bool& owns_path) {
+  int conn = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (conn < 0) {
+    std::cerr << "Failed to create socket: " << strerror(errno) << std::endl;
+    return takeover_result::failed;
+  }
+
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strncpy(addr.sun_path, handoff_path.c_str(), sizeof(addr.sun_path) - 1);
+
+  if (connect(conn, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+    int error = errno;
+    close(conn);
+    if (error != ENOENT && error != ECONNREFUSED) {
+      std::cerr << "Failed to connect to handoff socket: " << strerror(error) << std::endl;
+      return takeover_result::failed;
+    }
+
+    // An instance without hot restart support (an older build, or one whose
+    // handoff socket could not be created) may still be serving socket_path.
+    if (probe_socket(socket_path) == 0) {
+      std::cerr << "Running instance at " << socket_path << " does not support hot restart" << std::endl;
+      return takeover_result::failed;
+    }
+
+    std::cout << "No running instance to take over (" << strerror(error) << ")" << std::endl;
+    return takeover_result::no_instance;
+  }
+
+  // The handoff path is predictable; refuse a socket planted by another user.
+  if (!is_trusted_peer(conn)) {
+    std::cerr << "Refusing handoff from unauthorized peer on " << handoff_path << std::endl;
+    close(conn);
+    return takeover_result::failed;
+  }
+
+  // The predecessor may be busy in a command for up to max_press_ms.
+  struct timeval timeout;
+  timeout.tv_sec = handoff_timeout_ms / 1000;
+  timeout.tv_usec = (handoff_timeout_ms % 1000) * 1000;
+  setsockopt(conn, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+  std::string payload;
+  fd = receive_fd(conn, payload);
+  if (fd < 0) {
+    close(conn);
+    return takeover_result::failed;
+  }
+
+  // Do not acknowledge a snapshot we cannot restore.
+  held_state state;
+  try {
+    json snapshot = json::parse(payload);
+    state = parse_held_state(snapshot);
+    owns_path = snapshot.at("socket").at("owns_path").get<bool>();
+  } catch (const std::exception& e) {
+    std::cerr << "Failed to parse handoff state: " << e.what() << std::endl;
+    close(fd);
+    fd = -1;
+    close(conn);
+    return takeover_result::failed;
+  }
+
+  // Shutdown signals are blocked during the takeover. If one arrived while
+  // waiting, do not ack: the predecessor keeps serving and we exit.
+  sigset_t pending;
+  sigpending(&pending);
+  if (sigismember(&pending, SIGINT) || sigismember(&pending, SIGTERM)) {
+    std::cerr << "Shutdown requested, not acknowledging handoff" << std::endl;
+    close(fd);
+    fd = -1;
+    close(conn);
+    return takeover_result::failed;
+  }
+
+  if (!write_fully(conn, "ok", 2)) {
+    std::cerr << "Failed to acknowledge handoff" << std::endl;
+    close(fd);
+    fd = -1;
+    close(conn);
+    return takeover_result::failed;
+  }
+
+  // Wait for the predecessor to tear down its VHD client (EOF on `conn`) so
+  // its release of held keys cannot land after our replay.
+  struct timeval teardown_timeout;
+  teardown_timeout.tv_sec = predecessor_teardown_timeout_ms / 1000;
+  teardown_timeout.tv_usec = (predecessor_teardown_timeout_ms % 1000) * 1000;
+  setsockopt(conn, SOL_SOCKET, SO_RCVTIMEO, &teardown_timeout, sizeof(teardown_timeout));
+
+  char buffer[64];
+  ssize_t n;
+  do {
+    n = read(conn, buffer, sizeof(buffer));
+  } while (n > 0 || (n < 0 && errno == EINTR));
+  if (n < 0) {
+    std::cerr << "Predecessor teardown not confirmed (" << strerror(errno) << "), restoring held state anyway" << std::endl;
+  }
+
+  close(conn);
+  load_held_state(state);
+  return takeover_result::taken_over;
+}
+
+// Give the VHD client a head start so the predecessor keeps serving
+// while the devices are initialised. Returns false on timeout.
+bool wait_for_devices_ready(std::chrono::seconds timeout) {
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (!(keyboard_ready && pointing_ready) && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+  return keyboard_ready && pointing_ready;
+}
+
 }  // namespace
 
-int main(void) {
+int main(int argc, const char* argv[]) {
+  // Parse options
+  //   --takeover        take the listening socket and held state from a running instance
+  //   --listen-fd=<fd>  serve on an already bound (and listening) socket fd
+  // The two options are mutually exclusive.
+  bool takeover = false;
+  int listen_fd = -1;
+  bool usage_error = false;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--takeover") {
+      takeover = true;
+    } else if (arg.rfind("--listen-fd=", 0) == 0) {
+      const char* value = arg.c_str() + strlen("--listen-fd=");
+      char* end = nullptr;
+      errno = 0;
+      long fd = std::strtol(value, &end, 10);
+      if (!std::isdigit(static_cast<unsigned char>(*value)) || *end != '\0' || errno != 0 || fd < 0 || fd > INT_MAX) {
+        std::cerr << "Invalid listen fd: " << value << std::endl;
+        usage_error = true;
+      } else {
+        listen_fd = static_cast<int>(fd);
+      }
+    } else {
+      std::cerr << "Unknown option: " << arg << std::endl;
+      usage_error = true;
+    }
+  }
+
+  if (takeover && listen_fd >= 0) {
+    std::cerr << "--takeover and --listen-fd cannot be combined" << std::endl;
+    usage_error = true;
+  }
+
+  if (usage_error) {
+    std::cerr << "Usage: " << argv[0] << " [--takeover | --listen-fd=<fd>]" << std::endl;
+    return 1;
+  }
+
   // Setup signal handlers
   std::signal(SIGINT, signal_handler);
   std::signal(SIGTERM, signal_handler);
+  std::signal(SIGPIPE, SIG_IGN);
+
+  // Block shutdown signals in the threads started below so they are only
+  // delivered to this thread, which can defer them around a takeover.
+  sigset_t shutdown_signals = shutdown_signal_set();
+  pthread_sigmask(SIG_BLOCK, &shutdown_signals, nullptr);
 
   // Initialize dispatcher
   pqrs::dispatcher::extra::initialize_shared_dispatcher();
@@ -533,52 +1064,84 @@ int main(void) {
   std::cout << "Starting VirtualHID client..." << std::endl;
   setup_vhid_client();
 
+  pthread_sigmask(SIG_UNBLOCK, &shutdown_signals, nullptr);
+
   // Determine user ID
   const char* sudo_uid = std::getenv("SUDO_UID");
   uid_t uid = sudo_uid ? static_cast<uid_t>(std::atoi(sudo_uid)) : getuid();
 
-  // Create socket path
+  // Create socket paths
   socket_path = "/tmp/macs_vhid_" + std::to_string(uid) + ".sock";
+  handoff_path = "/tmp/macs_vhid_" + std::to_string(uid) + ".handoff.sock";
+
+  if (listen_fd >= 0) {
+    std::cout << "Using pre-bound socket fd: " << listen_fd << std::endl;
+    socket_fd = listen_fd;
+    owns_socket_path = false;
+
+    // Accept an fd that was bound but not yet put into listening state.
+    int accepting = 0;
+    socklen_t len = sizeof(accepting);
+    if (getsockopt(socket_fd, SOL_SOCKET, SO_ACCEPTCONN, &accepting, &len) < 0 ||
+        (!accepting && listen(socket_fd, 5) < 0)) {
+      std::cerr << "Invalid listen fd " << listen_fd << ": " << strerror(errno) << std::endl;
+      return 1;
+    }
+  } else if (takeover) {
+    std::cout << "Taking over from running instance via: " << handoff_path << std::endl;
+    if (!wait_for_devices_ready(std::chrono::seconds(10))) {
+      std::cerr << "Devices not ready, leaving the running instance in place" << std::endl;
+      return 1;
+    }
 
-  std::cout << "Creating Unix socket at: " << socket_path << std::endl;
+    // Defer shutdown signals until the takeover has settled.
+    pthread_sigmask(SIG_BLOCK, &shutdown_signals, nullptr);
+    if (exit_flag) {
+      std::cerr << "Shutdown requested, leaving the running instance in place" << std::endl;
+      return 1;
+    }
 
-  // Remove stale socket if exists
-  unlink(socket_path.c_str());
+    bool owns_path = false;
+    switch (request_takeover(socket_fd, owns_path)) {
+      case takeover_result::taken_over:
+        owns_socket_path = owns_path;
+        break;
+      case takeover_result::no_instance:
+        break;
+      case takeover_result::failed:
+        std::cerr << "Takeover failed, leaving the running instance in place" << std::endl;
+        return 1;
+    }
 
-  // Create socket
-  socket_fd = socket(AF_UNIX, SOCK_STREAM, 0);
-  if (socket_fd < 0) {
-    std::cerr << "Failed to create socket: " << strerror(errno) << std::endl;
-    return 1;
+    pthread_sigmask(SIG_UNBLOCK, &shutdown_signals, nullptr);
   }
 
-  // Bind socket
-  struct sockaddr_un addr;
-  memset(&addr, 0, sizeof(addr));
-  addr.sun_family = AF_UNIX;
-  strncpy(addr.sun_path, socket_path.c_str(), sizeof(addr.sun_path) - 1);
+  if (socket_fd < 0) {
+    std::cout << "Creating Unix socket at: " << socket_path << std::endl;
 
-  if (bind(socket_fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
-    std::cerr << "Failed to bind socket: " << strerror(errno) << std::endl;
-    close(socket_fd);
-    return 1;
+    // Remove stale socket if exists
+    unlink(socket_path.c_str());
+    socket_fd = create_listen_socket(socket_path, 0660, uid);
+    if (socket_fd < 0) {
+      return 1;
+    }
+    owns_socket_path = true;
   }
 
-  // Set permissions
-  if (chmod(socket_path.c_str(), 0660) < 0) {
-    std::cerr << "Failed to chmod socket: " << strerror(errno) << std::endl;
+  // Handoff socket for hot restarts (root or the service user only).
+  // Only replace a stale one; a live one belongs to another instance.
+  int handoff_probe = probe_socket(handoff_path);
+  if (handoff_probe == ECONNREFUSED) {
+    unlink(handoff_path.c_str());
   }
-
-  if (chown(socket_path.c_str(), uid, 0) < 0) {
-    std::cerr << "Failed to chown socket: " << strerror(errno) << std::endl;
+  if (handoff_probe == ENOENT || handoff_probe == ECONNREFUSED) {
+    handoff_fd = create_listen_socket(handoff_path, 0600, geteuid());
+  } else {
+    std::cerr << "Not replacing handoff socket " << handoff_path << ": "
+              << (handoff_probe == 0 ? "in use by another instance" : strerror(handoff_probe)) << std::endl;
   }
-
-  // Listen
-  if (listen(socket_fd, 5) < 0) {
-    std::cerr << "Failed to listen on socket: " << strerror(errno) << std::endl;
-    close(socket_fd);
-    unlink(socket_path.c_str());
-    return 1;
+  if (handoff_fd < 0) {
+    std::cerr << "Hot restart disabled" << std::endl;
   }
 
   std::cout << "Socket server ready. Press Ctrl+C to quit." << std::endl;
@@ -586,15 +1149,20 @@ int main(void) {
 
   // Main server loop
   while (!exit_flag) {
+    restore_held_state();
+
     fd_set read_fds;
     FD_ZERO(&read_fds);
     FD_SET(socket_fd, &read_fds);
+    if (handoff_fd >= 0) {
+      FD_SET(handoff_fd, &read_fds);
+    }
 
     struct timeval timeout;
     timeout.tv_sec = 1;
     timeout.tv_usec = 0;
 
-    int result = select(socket_fd + 1, &read_fds, nullptr, nullptr, &timeout);
+    int result = select(std::max(socket_fd, handoff_fd) + 1, &read_fds, nullptr, nullptr, &timeout);
 
     if (result < 0) {
       if (errno == EINTR) continue;
@@ -604,6 +1172,14 @@ int main(void) {
 
     if (result == 0) continue;  // Timeout
 
+    // Hot restart requested by a successor
+    if (handoff_fd >= 0 && FD_ISSET(handoff_fd, &read_fds)) {
+      serve_handoff();
+      if (handed_off) break;
+    }
+
+    if (!FD_ISSET(socket_fd, &read_fds)) continue;
+
     // Accept connection
     int client_fd = accept(socket_fd, nullptr, nullptr);
     if (client_fd < 0) {
@@ -659,7 +1235,23 @@ int main(void) {
   vhid_client = nullptr;
 
   close(socket_fd);
-  unlink(socket_path.c_str());
+  if (handoff_fd >= 0) {
+    close(handoff_fd);
+  }
+
+  // Tell the successor our VHD client is gone; it may now replay held state.
+  if (handoff_conn >= 0) {
+    close(handoff_conn);
+  }
+
+  if (!handed_off) {
+    if (owns_socket_path) {
+      unlink(socket_path.c_str());
+    }
+    if (handoff_fd >= 0) {
+      unlink(handoff_path.c_str());
+    }
+  }
 
   pqrs::dispatcher::extra::terminate_shared_dispatcher();
 